@@ -0,0 +1,97 @@
+//===-- bench/MachineSetup.cpp - Machine setup benchmark --------*- C++ -*-===//
+//
+// This file is distributed under the Boost Software License. See LICENSE.TXT
+// for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file measures the time and heap allocations needed to construct and
+/// destroy a machine, i.e. a bus with its memory mapped devices.
+///
+//===----------------------------------------------------------------------===//
+
+//==============================================================================
+//= Dependencies
+//==============================================================================
+// Local/Private headers
+#include "nes_emu/Bus.h"
+#include "nes_emu/Device/Sram.h"
+
+// External headers
+
+// System headers
+#include <chrono>   // steady_clock
+#include <cstdlib>  // malloc, free, strtoul
+#include <iostream> // cout
+#include <new>      // bad_alloc
+
+namespace {
+size_t allocations = 0;
+} // namespace
+
+void *operator new(size_t size) {
+  ++allocations;
+  if (void *p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t /*size*/) noexcept { std::free(p); }
+
+namespace {
+using nes_emu::Bus16;
+using nes_emu::Sram;
+
+/// CPU memory layout of a NROM cartridge machine.
+class Machine {
+public:
+  Machine() {
+    this->ram_.map(&this->bus_, 0x0000);
+    // internal RAM is mirrored up to $1FFF
+    for (Bus16::AddressType mirror = 0x0800; mirror < 0x2000;
+         mirror += this->ram_.size()) {
+      this->bus_.mapMemory(&this->ram_, mirror, this->ram_.size(),
+                           this->ram_.data());
+    }
+    this->prg_ram_.map(&this->bus_, 0x6000);
+    this->prg_rom_.map(&this->bus_, 0x8000);
+  }
+  const Bus16 &bus() const noexcept { return this->bus_; }
+
+private:
+  Bus16 bus_{nullptr};
+  Sram<0x800> ram_;
+  Sram<0x2000> prg_ram_;
+  Sram<0x8000> prg_rom_;
+};
+} // namespace
+
+int main(int argc, const char **argv) {
+  size_t iterations = 100000;
+  if (argc > 1) {
+    iterations = std::strtoul(argv[1], nullptr, 10);
+  }
+
+  volatile uint8_t sink = 0;
+  auto allocations_before = allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    Machine machine;
+    sink = machine.bus().read8(0xfffc);
+  }
+  auto end = std::chrono::steady_clock::now();
+  auto allocated = allocations - allocations_before;
+  static_cast<void>(sink);
+
+  auto ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  std::cout << "machine setup: " << iterations << " iterations, "
+            << static_cast<double>(ns) / static_cast<double>(iterations)
+            << " ns/machine, "
+            << static_cast<double>(allocated) /
+                   static_cast<double>(iterations)
+            << " allocations/machine" << std::endl;
+  return 0;
+}
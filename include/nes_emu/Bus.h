@@ -26,10 +26,10 @@
 #include <cstddef>      // size_t
 #include <cstdint>      // uint_fast16_t
 #include <functional>   // function
-#include <memory>       // unique_ptr
 #include <optional>     // optional
 #include <system_error> // errc
-#include <utility>      // move
+#include <type_traits>  // is_integral, is_unsigned
+#include <utility>      // move, index_sequence
 
 namespace nes_emu {
 class Device;
@@ -50,63 +50,154 @@ public:
   Bus(Bus &&) noexcept = default;
   Bus &operator=(Bus &&) noexcept = default;
 
+  /// Map \p bytes of \p mem owned by \p dev to \p address. Returns
+  /// errc::invalid_argument for a null device or memory or an empty range,
+  /// errc::bad_address when the range exceeds the address space, and
+  /// errc::file_exists when any page in the range is already mapped.
   std::optional<std::errc> mapMemory(Device *dev, AddressType address,
-                                     size_t bytes, void *mem);
-  void read(AddressType address, size_t bytes, void *buffer) const noexcept;
+                                     size_t bytes, void *mem) noexcept;
+  /// Wraps around the end of the address space. Returns false if a bus
+  /// error was reported.
+  bool read(AddressType address, size_t bytes, void *buffer) const noexcept;
   uint8_t read8(AddressType address) const noexcept {
     uint8_t ret;
     this->read(address, sizeof(ret), &ret);
     return ret;
   }
   uint16_t read16(AddressType address) const noexcept {
-    uint16_t ret;
-    this->read(address, sizeof(ret), &ret);
-    return ret;
+    return this->readLE<uint16_t>(address);
   }
   uint32_t read32(AddressType address) const noexcept {
-    uint32_t ret;
-    this->read(address, sizeof(ret), &ret);
-    return ret;
+    return this->readLE<uint32_t>(address);
   }
   uint64_t read64(AddressType address) const noexcept {
-    uint64_t ret;
-    this->read(address, sizeof(ret), &ret);
-    return ret;
+    return this->readLE<uint64_t>(address);
   }
-  void write(const void *buffer, size_t bytes,
+  /// Read the little-endian value wrapping within the 256-byte page, as the
+  /// 6502 does for zero-page pointers ($FF -> $00) and JMP ($xxFF).
+  uint16_t read16Wrapped(AddressType address) const noexcept {
+    return this->readLEWrapped<uint16_t>(address);
+  }
+  /// Wraps around the end of the address space. Returns false if a bus
+  /// error was reported.
+  bool write(const void *buffer, size_t bytes,
              AddressType destination) noexcept;
   void write8(AddressType destination, const uint8_t &value) noexcept {
     this->write(&value, sizeof(value), destination);
   }
   void write16(AddressType destination, const uint16_t &value) noexcept {
-    this->write(&value, sizeof(value), destination);
+    this->writeLE<uint16_t>(destination, value);
   }
   void write32(AddressType destination, const uint32_t &value) noexcept {
-    this->write(&value, sizeof(value), destination);
+    this->writeLE<uint32_t>(destination, value);
   }
   void write64(AddressType destination, const uint64_t &value) noexcept {
-    this->write(&value, sizeof(value), destination);
+    this->writeLE<uint64_t>(destination, value);
+  }
+  void write16Wrapped(AddressType destination, const uint16_t &value) noexcept {
+    this->writeLEWrapped<uint16_t>(destination, value);
+  }
+
+  /// Read a little-endian value regardless of the host byte order. An access
+  /// that stays within one mapping is a single load; the rest wraps around
+  /// the end of the address space.
+  template <typename T> T readLE(AddressType address) const noexcept {
+    return this->readLEIn<T>(address, kAddressMask);
+  }
+  /// Same as readLE, but wraps within the 256-byte page of \p address.
+  template <typename T> T readLEWrapped(AddressType address) const noexcept {
+    return this->readLEIn<T>(address, kWrapPageMask);
+  }
+  /// Write a little-endian value regardless of the host byte order.
+  template <typename T>
+  void writeLE(AddressType destination, T value) noexcept {
+    this->writeLEIn<T>(destination, value, kAddressMask);
+  }
+  /// Same as writeLE, but wraps within the 256-byte page of \p destination.
+  template <typename T>
+  void writeLEWrapped(AddressType destination, T value) noexcept {
+    this->writeLEIn<T>(destination, value, kWrapPageMask);
   }
   void dumpMap() const noexcept;
 
 private:
+  /// The whole mapped range; every page it covers holds a copy of it.
   struct MemoryMap {
-    explicit MemoryMap(Device *owner, void *memory, AddressType address,
-                       size_t bytes)
-        : Owner(owner), Memory(static_cast<uint8_t *>(memory)),
-          Address(address), Bytes(bytes) {}
-    Device *Owner;
-    uint8_t *Memory;
-    AddressType Address;
-    size_t Bytes;
+    Device *Owner = nullptr;
+    uint8_t *Memory = nullptr; // nullptr if not mapped
+    AddressType Address = 0;
+    size_t Bytes = 0;
   };
   static constexpr auto kAddressBits = address_bits;
   static constexpr auto kPageSizeBits = 10;
   static constexpr auto kPageNum = 1ULL << (kAddressBits - kPageSizeBits);
   static constexpr AddressType kPageSize = 1 << kPageSizeBits;
   static constexpr std::uintptr_t kPageMask = kPageSize - 1;
+  static constexpr AddressType kAddressMask = (1ULL << kAddressBits) - 1;
+  static constexpr AddressType kWrapPageMask = 0xFF;
+
+  template <typename T, size_t... I>
+  static constexpr T loadLE(const uint8_t *p,
+                            std::index_sequence<I...> /*unused*/) noexcept {
+    return static_cast<T>(
+        (static_cast<T>(static_cast<T>(p[I]) << (8U * I)) | ...));
+  }
+  template <typename T, size_t... I>
+  static constexpr void storeLE(uint8_t *p, T value,
+                                std::index_sequence<I...> /*unused*/) noexcept {
+    ((p[I] = static_cast<uint8_t>(value >> (8U * I))), ...);
+  }
+  /// Return the host pointer when [address, address + bytes) lies within a
+  /// single mapping, nullptr otherwise. \p address must be within the
+  /// address space.
+  uint8_t *directMemory(AddressType address, size_t bytes) const noexcept {
+    const auto &map = this->map_table_[address >> kPageSizeBits];
+    if (map.Memory == nullptr || address < map.Address) {
+      return nullptr;
+    }
+    auto offset = address - map.Address;
+    if (offset >= map.Bytes || map.Bytes - offset < bytes) {
+      return nullptr;
+    }
+    return map.Memory + offset;
+  }
+  template <typename T>
+  T readLEIn(AddressType address, AddressType wrap_mask) const noexcept {
+    static_assert(std::is_integral_v<T> && std::is_unsigned_v<T>,
+                  "T must be an unsigned integer");
+    address &= kAddressMask;
+    if ((address & wrap_mask) + sizeof(T) - 1 <= wrap_mask) {
+      if (auto p = this->directMemory(address, sizeof(T))) {
+        return loadLE<T>(p, std::make_index_sequence<sizeof(T)>{});
+      }
+    }
+    uint8_t buf[sizeof(T)] = {};
+    this->readWrapped(address, sizeof(T), buf, wrap_mask);
+    return loadLE<T>(buf, std::make_index_sequence<sizeof(T)>{});
+  }
+  template <typename T>
+  void writeLEIn(AddressType destination, T value,
+                 AddressType wrap_mask) noexcept {
+    static_assert(std::is_integral_v<T> && std::is_unsigned_v<T>,
+                  "T must be an unsigned integer");
+    destination &= kAddressMask;
+    if ((destination & wrap_mask) + sizeof(T) - 1 <= wrap_mask) {
+      if (auto p = this->directMemory(destination, sizeof(T))) {
+        storeLE<T>(p, value, std::make_index_sequence<sizeof(T)>{});
+        return;
+      }
+    }
+    uint8_t buf[sizeof(T)];
+    storeLE<T>(buf, value, std::make_index_sequence<sizeof(T)>{});
+    this->writeWrapped(buf, sizeof(T), destination, wrap_mask);
+  }
+  void readWrapped(AddressType address, size_t bytes, void *buffer,
+                   AddressType wrap_mask) const noexcept;
+  void writeWrapped(const void *buffer, size_t bytes, AddressType destination,
+                    AddressType wrap_mask) noexcept;
+
   std::function<void(AddressType, BusAccessKind)> notify_error_;
-  std::array<std::unique_ptr<MemoryMap>, kPageNum> map_table_;
+  std::array<MemoryMap, kPageNum> map_table_{};
 };
 
 using Bus16 = Bus<16>;
@@ -32,101 +32,146 @@ namespace nes_emu {
 template <size_t address_bits> Bus<address_bits>::~Bus() noexcept = default;
 
 template <size_t address_bits>
-std::optional<std::errc> Bus<address_bits>::mapMemory(Device *dev,
-                                                      AddressType address,
-                                                      size_t bytes, void *mem) {
+std::optional<std::errc>
+Bus<address_bits>::mapMemory(Device *dev, AddressType address, size_t bytes,
+                             void *mem) noexcept {
+  // validate
+  if (dev == nullptr || mem == nullptr || bytes == 0) {
+    return std::errc::invalid_argument;
+  }
+  if (address > this->kAddressMask ||
+      bytes > this->kAddressMask - address + 1) {
+    return std::errc::bad_address;
+  }
   auto page_begin = address >> this->kPageSizeBits;
   auto page_end = (address + bytes - 1) >> this->kPageSizeBits;
-  auto mem_addr = static_cast<uint8_t *>(mem);
-  // chack already exists
+  // check already exists
   for (auto page = page_begin; page <= page_end; ++page) {
-    if (this->map_table_[page]) {
+    if (this->map_table_[page].Memory != nullptr) {
       return std::errc::file_exists;
     }
   }
   // map
-  auto offset = address - (page_begin << this->kPageSizeBits);
+  const MemoryMap map{dev, static_cast<uint8_t *>(mem), address, bytes};
   for (auto page = page_begin; page <= page_end; ++page) {
-    this->map_table_[page] = std::make_unique<MemoryMap>(
-        dev, mem_addr, (page << this->kPageSizeBits) + offset,
-        std::min(bytes, this->kPageSize));
-    bytes -= this->kPageSize;
-    mem_addr += this->kPageSize;
-    offset = 0;
+    this->map_table_[page] = map;
   }
   return std::nullopt;
 }
 
 template <size_t address_bits>
-void Bus<address_bits>::read(AddressType address, size_t bytes,
+bool Bus<address_bits>::read(AddressType address, size_t bytes,
                              void *buffer) const noexcept {
   decltype(bytes) readed_bytes = 0;
   auto p = static_cast<uint8_t *>(buffer);
   while (readed_bytes < bytes) {
-    auto reading_address = address + readed_bytes;
+    auto reading_address = (address + readed_bytes) & this->kAddressMask;
     auto page = reading_address >> this->kPageSizeBits;
     const auto &map = this->map_table_[page];
-    if (map) {
-      auto offset = reading_address - map->Address;
-      auto reading_bytes = std::min(bytes - readed_bytes - offset, map->Bytes);
-      if ((reading_address < map->Address) ||
-          (map->Address + map->Bytes < reading_address + reading_bytes)) {
+    if (map.Memory != nullptr) {
+      auto offset = reading_address - map.Address;
+      if ((reading_address < map.Address) || (map.Bytes <= offset)) {
         if (this->notify_error_ != nullptr) {
-          this->notify_error_(map->Address + offset, BusAccessKind::kRead);
+          this->notify_error_(reading_address, BusAccessKind::kRead);
         }
-        return;
+        return false;
       }
-      std::memcpy(p + readed_bytes, map->Memory + offset, reading_bytes);
+      auto reading_bytes = std::min(bytes - readed_bytes, map.Bytes - offset);
+      std::memcpy(p + readed_bytes, map.Memory + offset, reading_bytes);
       readed_bytes += reading_bytes;
     } else {
       if (this->notify_error_ != nullptr) {
-        this->notify_error_(address, BusAccessKind::kRead);
+        this->notify_error_(reading_address, BusAccessKind::kRead);
       }
-      return;
+      return false;
     }
   }
+  return true;
 }
 
 template <size_t address_bits>
-void Bus<address_bits>::write(const void *buffer, size_t bytes,
+bool Bus<address_bits>::write(const void *buffer, size_t bytes,
                               AddressType destination) noexcept {
   decltype(bytes) written_bytes = 0;
   auto p = static_cast<const uint8_t *>(buffer);
   while (written_bytes < bytes) {
-    auto writing_address = destination + written_bytes;
+    auto writing_address =
+        (destination + written_bytes) & this->kAddressMask;
     auto page = writing_address >> this->kPageSizeBits;
-    auto &map = this->map_table_[page];
-    if (map) {
-      auto offset = writing_address - map->Address;
-      auto writing_bytes = std::min(bytes - written_bytes - offset, map->Bytes);
-      if ((writing_address < map->Address) ||
-          (map->Address + map->Bytes < writing_address + writing_bytes)) {
+    const auto &map = this->map_table_[page];
+    if (map.Memory != nullptr) {
+      auto offset = writing_address - map.Address;
+      if ((writing_address < map.Address) || (map.Bytes <= offset)) {
         if (this->notify_error_ != nullptr) {
-          this->notify_error_(map->Address + offset, BusAccessKind::kWrite);
+          this->notify_error_(writing_address, BusAccessKind::kWrite);
         }
-        return;
+        return false;
       }
-      std::memcpy(map->Memory + offset, p + written_bytes, writing_bytes);
+      auto writing_bytes = std::min(bytes - written_bytes, map.Bytes - offset);
+      std::memcpy(map.Memory + offset, p + written_bytes, writing_bytes);
       written_bytes += writing_bytes;
     } else {
       if (this->notify_error_ != nullptr) {
-        this->notify_error_(destination, BusAccessKind::kWrite);
+        this->notify_error_(writing_address, BusAccessKind::kWrite);
       }
+      return false;
+    }
+  }
+  return true;
+}
+
+template <size_t address_bits>
+void Bus<address_bits>::readWrapped(AddressType address, size_t bytes,
+                                    void *buffer,
+                                    AddressType wrap_mask) const noexcept {
+  auto p = static_cast<uint8_t *>(buffer);
+  while (bytes > 0) {
+    auto reading_bytes =
+        std::min<size_t>(bytes, wrap_mask - (address & wrap_mask) + 1);
+    if (!this->read(address, reading_bytes, p)) {
       return;
     }
+    p += reading_bytes;
+    bytes -= reading_bytes;
+    // continue from the beginning of the wrapping region
+    address &= ~wrap_mask;
+  }
+}
+
+template <size_t address_bits>
+void Bus<address_bits>::writeWrapped(const void *buffer, size_t bytes,
+                                     AddressType destination,
+                                     AddressType wrap_mask) noexcept {
+  auto p = static_cast<const uint8_t *>(buffer);
+  while (bytes > 0) {
+    auto writing_bytes =
+        std::min<size_t>(bytes, wrap_mask - (destination & wrap_mask) + 1);
+    if (!this->write(p, writing_bytes, destination)) {
+      return;
+    }
+    p += writing_bytes;
+    bytes -= writing_bytes;
+    // continue from the beginning of the wrapping region
+    destination &= ~wrap_mask;
   }
 }
 
 template <size_t address_bits>
 void Bus<address_bits>::dumpMap() const noexcept {
+  auto flags = std::cout.flags();
   std::cout << "dump map(" << this->kPageSize << ")\n";
   std::cout << "--------\n";
-  for (const auto &map : this->map_table_) {
-    if (map) {
-      std::cout << std::hex << map->Address << "\t" << std::hex << map->Bytes
-                << std::endl;
+  for (AddressType page = 0; page < this->kPageNum; ++page) {
+    const auto &map = this->map_table_[page];
+    if (map.Memory == nullptr) {
+      continue;
     }
+    std::cout << std::hex << map.Address << "\t" << std::hex << map.Bytes
+              << std::endl;
+    // a mapping spanning several pages is shown once
+    page = (map.Address + map.Bytes - 1) >> this->kPageSizeBits;
   }
+  std::cout.flags(flags);
 }
 
 template class Bus<16>;
@@ -52,10 +52,35 @@ TEST_F(Bus16Test, MapToExists) {
   EXPECT_TRUE(ret);
   EXPECT_EQ(ret.value(), std::errc::file_exists);
 }
+TEST_F(Bus16Test, MapInvalidArgument) {
+  // Do
+  auto no_device = this->bus_.mapMemory(nullptr, 0, 1, this->p1_);
+  auto no_memory = this->bus_.mapMemory(&this->sram1_, 0, 1, nullptr);
+  auto no_bytes = this->bus_.mapMemory(&this->sram1_, 0, 0, this->p1_);
+  // Verify
+  ASSERT_TRUE(no_device);
+  EXPECT_EQ(no_device.value(), std::errc::invalid_argument);
+  ASSERT_TRUE(no_memory);
+  EXPECT_EQ(no_memory.value(), std::errc::invalid_argument);
+  ASSERT_TRUE(no_bytes);
+  EXPECT_EQ(no_bytes.value(), std::errc::invalid_argument);
+}
+TEST_F(Bus16Test, MapOutOfAddressSpace) {
+  // Do
+  auto over_end = this->sram1_.map(&this->bus_, 0xfc01);
+  auto beyond = this->sram1_.map(&this->bus_, 0x10000);
+  // Verify
+  ASSERT_TRUE(over_end);
+  EXPECT_EQ(over_end.value(), std::errc::bad_address);
+  ASSERT_TRUE(beyond);
+  EXPECT_EQ(beyond.value(), std::errc::bad_address);
+  EXPECT_FALSE(this->sram1_.map(&this->bus_, 0xfc00));
+}
 TEST_F(Bus16Test, MapToMiddle) {
   // Setup
   ASSERT_FALSE(this->sram1_.map(&this->bus_, 0x100));
-  uint8_t buf[0x400 + 1] = {0};
+  uint8_t buf[0x400 + 1];
+  memset(buf, 0xce, sizeof(buf));
   uint_fast16_t addr = 0x100;
   uint_fast16_t bytes = this->sram1_.size();
   // Do
@@ -63,7 +88,7 @@ TEST_F(Bus16Test, MapToMiddle) {
   // Verify
   EXPECT_BUS_ERROR(0, 0, BusAccessKind::kNone);
   EXPECT_EQ(std::memcmp(buf, this->p1_, bytes), 0);
-  EXPECT_NE(buf[bytes], this->p1_[bytes]);
+  EXPECT_EQ(buf[bytes], 0xce);
 }
 
 TEST_F(Bus16Test, ReadForNotRegisterd) {
@@ -115,6 +140,48 @@ TEST_F(Bus16Test, ReadAcrossTwoMap) {
   EXPECT_EQ(buf[this->sram1_.size() + 0x100], 0);
 }
 
+TEST_F(Bus16Test, ReadAcrossPagesOfOneMap) {
+  // Setup
+  Sram<0x1000> sram;
+  for (size_t i = 0; i < sram.size(); ++i) {
+    sram.data()[i] = static_cast<uint8_t>(i);
+  }
+  ASSERT_FALSE(sram.map(&this->bus_, 0x2200));
+  uint8_t buf[0x1000] = {0};
+  // Do
+  this->bus_.read(0x2300, 0xe00, buf);
+  // Verify
+  EXPECT_BUS_ERROR(0, 0, BusAccessKind::kNone);
+  EXPECT_EQ(std::memcmp(buf, sram.data() + 0x100, 0xe00), 0);
+  EXPECT_EQ(buf[0xe00], 0);
+  // Do
+  this->bus_.read(0x3100, 0x200, buf);
+  // Verify: mapping ends at 0x3200
+  EXPECT_BUS_ERROR(1, 0x3200, BusAccessKind::kRead);
+}
+
+TEST_F(Bus16Test, ReadWrapsAddressSpace) {
+  // Setup
+  ASSERT_FALSE(this->sram1_.map(&this->bus_, 0));
+  ASSERT_FALSE(this->sram2_.map(&this->bus_, 0xfc00));
+  uint8_t buf[0x20] = {0};
+  // Do
+  EXPECT_TRUE(this->bus_.read(0xfff0, sizeof(buf), buf));
+  // Verify
+  EXPECT_BUS_ERROR(0, 0, BusAccessKind::kNone);
+  EXPECT_EQ(std::memcmp(buf, this->p2_ + 0x3f0, 0x10), 0);
+  EXPECT_EQ(std::memcmp(buf + 0x10, this->p1_, 0x10), 0);
+}
+TEST_F(Bus16Test, ReadWrapsAddressSpaceForNotRegisterd) {
+  // Setup
+  ASSERT_FALSE(this->sram2_.map(&this->bus_, 0xfc00));
+  uint8_t buf[0x20] = {0};
+  // Do
+  EXPECT_FALSE(this->bus_.read(0xfff0, sizeof(buf), buf));
+  // Verify: the fault is at $0000
+  EXPECT_BUS_ERROR(1, 0, BusAccessKind::kRead);
+}
+
 TEST_F(Bus16Test, WriteForNotRegisterd) {
   // Setup
   const uint8_t buf[2] = {0};
@@ -149,6 +216,21 @@ TEST_F(Bus16Test, WriteOver) {
   EXPECT_BUS_ERROR(1, addr + this->sram1_.size(), BusAccessKind::kWrite);
 }
 
+TEST_F(Bus16Test, WriteWrapsAddressSpace) {
+  // Setup
+  ASSERT_FALSE(this->sram1_.map(&this->bus_, 0));
+  ASSERT_FALSE(this->sram2_.map(&this->bus_, 0xfc00));
+  uint8_t buf[0x20];
+  memset(buf, 0xce, sizeof(buf));
+  // Do
+  EXPECT_TRUE(this->bus_.write(buf, sizeof(buf), 0xfff0));
+  // Verify
+  EXPECT_BUS_ERROR(0, 0, BusAccessKind::kNone);
+  EXPECT_EQ(std::memcmp(buf, this->p2_ + 0x3f0, 0x10), 0);
+  EXPECT_EQ(std::memcmp(buf + 0x10, this->p1_, 0x10), 0);
+  EXPECT_EQ(this->p1_[0x10], 0x01);
+}
+
 TEST_F(Bus16Test, WriteReadForRegisterdOne) {
   // Setup
   ASSERT_FALSE(this->sram1_.map(&this->bus_, 0x8000));
@@ -239,4 +321,130 @@ TEST_F(Bus16Test, WriteRead64) {
   EXPECT_BUS_ERROR(0, 0, BusAccessKind::kNone);
   EXPECT_EQ(ret, 0x0123456789abcdef);
 }
+TEST_F(Bus16Test, Write16IsLittleEndian) {
+  // Setup
+  ASSERT_FALSE(this->sram1_.map(&this->bus_, 0x8000));
+  uint_fast16_t addr = 0x8000;
+  // Do
+  this->bus_.write16(addr, 0x0123);
+  // Verify: low byte first
+  EXPECT_BUS_ERROR(0, 0, BusAccessKind::kNone);
+  EXPECT_EQ(this->p1_[0], 0x23);
+  EXPECT_EQ(this->p1_[1], 0x01);
+}
+TEST_F(Bus16Test, Read32IsLittleEndian) {
+  // Setup
+  ASSERT_FALSE(this->sram1_.map(&this->bus_, 0x8000));
+  const uint8_t bytes[] = {0x67, 0x45, 0x23, 0x01};
+  std::memcpy(this->p1_ + 1, bytes, sizeof(bytes));
+  // Do
+  auto ret = this->bus_.read32(0x8001);
+  // Verify
+  EXPECT_BUS_ERROR(0, 0, BusAccessKind::kNone);
+  EXPECT_EQ(ret, 0x01234567);
+}
+TEST_F(Bus16Test, WriteRead32AcrossTwoMap) {
+  // Setup
+  ASSERT_FALSE(this->sram1_.map(&this->bus_, 0x400));
+  ASSERT_FALSE(this->sram2_.map(&this->bus_, 0x800));
+  uint_fast16_t addr = 0x7fe;
+  // Do
+  this->bus_.write32(addr, 0x01234567);
+  auto ret = this->bus_.read32(addr);
+  // Verify
+  EXPECT_BUS_ERROR(0, 0, BusAccessKind::kNone);
+  EXPECT_EQ(ret, 0x01234567);
+  EXPECT_EQ(this->p1_[0x3fe], 0x67);
+  EXPECT_EQ(this->p1_[0x3ff], 0x45);
+  EXPECT_EQ(this->p2_[0], 0x23);
+  EXPECT_EQ(this->p2_[1], 0x01);
+}
+TEST_F(Bus16Test, Read16Wrapped) {
+  // Setup
+  ASSERT_FALSE(this->sram1_.map(&this->bus_, 0));
+  this->p1_[0x00] = 0x01;
+  this->p1_[0xff] = 0x23;
+  this->p1_[0x100] = 0x45;
+  this->p1_[0x2ff] = 0x67;
+  this->p1_[0x200] = 0x89;
+  // Do
+  auto zero_page = this->bus_.read16Wrapped(0xff);
+  auto indirect = this->bus_.read16Wrapped(0x2ff);
+  auto unwrapped = this->bus_.read16(0xff);
+  // Verify: the high byte comes from the beginning of the same page
+  EXPECT_BUS_ERROR(0, 0, BusAccessKind::kNone);
+  EXPECT_EQ(zero_page, 0x0123);
+  EXPECT_EQ(indirect, 0x8967);
+  EXPECT_EQ(unwrapped, 0x4523);
+}
+TEST_F(Bus16Test, Write16Wrapped) {
+  // Setup
+  ASSERT_FALSE(this->sram1_.map(&this->bus_, 0));
+  // Do
+  this->bus_.write16Wrapped(0xff, 0x0123);
+  // Verify
+  EXPECT_BUS_ERROR(0, 0, BusAccessKind::kNone);
+  EXPECT_EQ(this->p1_[0xff], 0x23);
+  EXPECT_EQ(this->p1_[0x00], 0x01);
+  EXPECT_EQ(this->p1_[0x100], 0x01);
+}
+TEST_F(Bus16Test, Read16WrapsAddressSpace) {
+  // Setup
+  ASSERT_FALSE(this->sram1_.map(&this->bus_, 0));
+  ASSERT_FALSE(this->sram2_.map(&this->bus_, 0xfc00));
+  this->p1_[0] = 0x01;
+  this->p2_[0x3ff] = 0x23;
+  // Do
+  auto ret = this->bus_.read16(0xffff);
+  // Verify
+  EXPECT_BUS_ERROR(0, 0, BusAccessKind::kNone);
+  EXPECT_EQ(ret, 0x0123);
+}
+TEST_F(Bus16Test, WriteRead16BeyondAddressSpace) {
+  // Setup
+  ASSERT_FALSE(this->sram1_.map(&this->bus_, 0));
+  // Do
+  this->bus_.write16(0x10000, 0x0123);
+  auto ret = this->bus_.read16(0x10000);
+  // Verify: the address wraps to $0000
+  EXPECT_BUS_ERROR(0, 0, BusAccessKind::kNone);
+  EXPECT_EQ(ret, 0x0123);
+  EXPECT_EQ(this->p1_[0], 0x23);
+  EXPECT_EQ(this->p1_[1], 0x01);
+}
+TEST_F(Bus16Test, Read16ForNotRegisterd) {
+  // Setup
+  ASSERT_FALSE(this->sram1_.map(&this->bus_, 0x400));
+  // Do
+  this->bus_.read16(0x3ff);
+  // Verify
+  EXPECT_BUS_ERROR(1, 0x3ff, BusAccessKind::kRead);
+}
+TEST_F(Bus16Test, Read16WrappedForNotRegisterd) {
+  // Do
+  this->bus_.read16Wrapped(0x2ff);
+  // Verify: stops at the first fault
+  EXPECT_BUS_ERROR(1, 0x2ff, BusAccessKind::kRead);
+}
+TEST_F(Bus16Test, Write16WrapsAddressSpaceForNotRegisterd) {
+  // Do
+  this->bus_.write16(0xffff, 0x0123);
+  // Verify: stops at the first fault
+  EXPECT_BUS_ERROR(1, 0xffff, BusAccessKind::kWrite);
+}
+TEST_F(Bus16Test, DumpMapWithMirror) {
+  // Setup
+  Sram<0x800> ram;
+  ASSERT_FALSE(ram.map(&this->bus_, 0x0000));
+  ASSERT_FALSE(this->bus_.mapMemory(&ram, 0x0800, ram.size(), ram.data()));
+  // Do
+  testing::internal::CaptureStdout();
+  this->bus_.dumpMap();
+  auto output = testing::internal::GetCapturedStdout();
+  // Verify: each mirror is listed once
+  EXPECT_EQ(output, "dump map(1024)\n"
+                    "--------\n"
+                    "0\t800\n"
+                    "800\t800\n");
+}
 } // namespace nes_emu